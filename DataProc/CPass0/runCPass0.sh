@@ -249,6 +249,11 @@ else
     cp $ALIDPG_ROOT/DataProc/CPass0/recCPass0.C .
 fi
 
+# event-range parallel reconstruction of the chunk, if requested (recWorkers)
+source $ALIDPG_ROOT/DataProc/Common/parallelRec.sh
+[ -f "$CHUNKNAME" ] && [ "${CHUNKNAME:0:1}" != "/" ] && CHUNKNAME="`pwd`/$CHUNKNAME"
+parallelRecWorkers "$CHUNKNAME" "$triggerAlias" $nEvents
+
 echo ""
 echo "running the following recCPass0.C macro:"
 cat recCPass0.C
@@ -257,8 +262,15 @@ echo executing aliroot -l -b -q -x "recCPass0.C(\"$CHUNKNAME\", $nEvents, \"$ocd
 echo "" >&2
 echo "recCPass0.C" >&2
 timeStart=`date +%s`
-time aliroot -l -b -q -x "recCPass0.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")" &> rec.log
+TIMEFORMAT="real %3R user %3U sys %3S"
+if [ "$recWorkersUsed" -gt 1 ]; then
+    { time parallelRec $recWorkersUsed $recEvents "recCPass0.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")" rec.log ; } 2> rectime.tmp
+else
+    { time aliroot -l -b -q -x "recCPass0.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")" &> rec.log ; } 2> rectime.tmp
+fi
 exitcode=$?
+unset TIMEFORMAT
+cat rectime.tmp >&2
 timeEnd=`date +%s`
 timeUsed=$(( $timeUsed+$timeEnd-$timeStart ))
 delta=$(( $timeEnd-$timeStart ))
@@ -266,6 +278,11 @@ echo "recCPass0:  delta = $delta, timeUsed so far = $timeUsed"
 echo "recCPass0:  delta = $delta, timeUsed so far = $timeUsed" >&2
 parseRecLog rec.log
 
+# performance record of the reconstruction in telemetry.json/telemetry.csv
+read _ recReal _ recUser _ recSys < <(tail -n 1 rectime.tmp)
+rm -f rectime.tmp
+$ALIDPG_ROOT/DataProc/Common/stageTelemetry.sh "RECONSTRUCTION CPASS0" rec.log 1 syswatch.log "$recReal" "$recUser" "$recSys" $exitcode
+
 echo "*! Exit code of recCPass0.C: $exitcode"
 
 if [ $exitcode -ne 0 ]; then
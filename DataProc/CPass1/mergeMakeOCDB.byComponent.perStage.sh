@@ -27,6 +27,11 @@ main()
     echo  "  maxChunksTPC=3000    (max number of chunks to be merged for TPC calibration)"
     echo  "  makeOCDB={1,0}  run (or not) makeOCDB"
     echo  "  calibObjectsFileName={AliESDfriends_v1.root, CalibObjects.root "
+    echo  "  mergeMode={serial,tree}  (tree: merge each bunch while downloading the next, then merge the partial results in a tree)"
+    echo  "  mergeWorkers=N       (tree mode: max number of concurrent merging processes, default ALIEN_JDL_CPUCORES or 1)"
+    echo  "  mergeFanIn=8         (tree mode: number of partial results merged together at each level)"
+    echo  "  mergeMemoryLimit=0   (tree mode: memory limit in MB for the concurrent merges, 0 for no limit)"
+    echo  "  mergeBenchmark={0,1} (merge only, no makeOCDB, and report the merging rates)"
 
     echo
     echo "example:"
@@ -51,6 +56,11 @@ main()
   maxChunksTPC=3000
   makeOCDB=1
   calibObjectsFileName="CalibObjects.root"
+  mergeMode="serial"
+  mergeWorkers=""
+  mergeFanIn=8
+  mergeMemoryLimit=0
+  mergeBenchmark=0
   [[ -n ${ALIEN_JDL_TTL} ]] && maxTimeToLive=$(( ${ALIEN_JDL_TTL}-2000 ))
 
   # ===| TPC default values |===================================================
@@ -79,6 +89,8 @@ main()
   [[ $filesAreLocal -eq 1 ]] && cleanup=0
   [[ $filesAreLocal -eq 1 ]] && fileAccessMethod="nocopy"
   [[ ${path} =~ \.xml ]] && fileAccessMethod="copyXMLcollection"
+  [[ "$mergeMode" != "tree" ]] && mergeMode="serial"
+  [[ $mergeBenchmark -eq 1 ]] && makeOCDB=0
 
   # setup components to be merged
   #components="TOF MeanVertex T0 SDD TRD TPCCalib TPCCluster TPCAlign"
@@ -126,6 +138,8 @@ main()
   echo detectorBitsQualityFlag = $detectorBitsQualityFlag | tee -a merge.log
   echo "makeOCDB = $makeOCDB" | tee -a merge.log
   echo "calibObjectsFileName = $calibObjectsFileName" | tee -a merge.log
+  echo "mergeMode = $mergeMode" | tee -a merge.log
+  echo "mergeBenchmark = $mergeBenchmark" | tee -a merge.log
   echo "***********************" | tee -a merge.log
 
   alienFileList="alien.list"
@@ -178,6 +192,14 @@ main()
   #split --numeric-suffixes --suffix-length=6 --lines=$numberOfFilesInAbunch ${alienFileList} ${partialAlienFileListPrefix}
   split -a 6 -l $numberOfFilesInAbunch ${alienFileList} ${partialAlienFileListPrefix}
 
+  if [[ "$mergeMode" == "tree" ]]; then
+    source $ALIDPG_ROOT/DataProc/MergeOutputs/mergeTree.sh
+    treeMergeInit
+  fi
+  mergeStart=$(date +%s)
+  mergeFiles=0
+  mergeBytes=0
+
   for partialAlienFileList in ${partialAlienFileListPrefix}*
   do
 
@@ -217,6 +239,17 @@ main()
       [[ -f syswatch.log ]] && mv syswatch.log syswatch_copy.log
     fi
 
+    # input of the merging rates reported with mergeBenchmark, for both modes
+    if [[ $mergeBenchmark -eq 1 ]]; then
+      mergeFiles=$((mergeFiles+$(grep -c "\.root" $partialLocalFileList)))
+      mergeBytes=$((mergeBytes+$(sed 's/#.*//' $partialLocalFileList | xargs ls -l 2>/dev/null | awk '{s+=$5} END {print s+0}')))
+    fi
+
+    if [[ "$mergeMode" == "tree" ]]; then
+      treeMergeLeaf $partialLocalFileList $cleanup
+      continue
+    fi
+
     echo waiting
     wait $!
     if [[ $runParallel -eq 1 ]]; then
@@ -229,7 +262,15 @@ main()
   #merge all the subfiles into one, wait for the last one to complete
   echo waiting
   wait $!
-  if [[ "$components" =~ ALL && -f CalibObjects_ALL.root ]]; then
+  if [[ "$mergeMode" == "tree" ]]; then
+    echo "***********************"
+    echo tree merging ALL data
+    echo "***********************"
+    if ! treeMergeReduce; then
+      echo tree merging failed, exiting...
+      return 1
+    fi
+  elif [[ "$components" =~ ALL && -f CalibObjects_ALL.root ]]; then
     mv -f CalibObjects_ALL.root CalibObjects.root
   else
     echo "***********************"
@@ -247,6 +288,12 @@ main()
     return 1
   fi
   rm -f CalibObjects_*.root
+  if [[ $mergeBenchmark -eq 1 ]]; then
+    mergeElapsed=$(( $(date +%s)-mergeStart ))
+    [[ $mergeElapsed -lt 1 ]] && mergeElapsed=1
+    echo "merging ($mergeMode): $mergeFiles files, $((mergeBytes/1048576)) MB in $mergeElapsed s:" \
+         "$(awk "BEGIN {printf \"%.2f files/s, %.2f MB/s\", $mergeFiles/$mergeElapsed, $mergeBytes/1048576/$mergeElapsed}")" | tee -a merge.log
+  fi
 
   #cleanup
   rm -f ${partialAlienFileListPrefix}*
@@ -372,8 +372,11 @@ cat recCPass1.C
 echo ""
 echo executing aliroot -l -b -q -x "recCPass1.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")"
 timeStart=`date +%s`
-time aliroot -l -b -q -x "recCPass1.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")" &> ../rec.log
+TIMEFORMAT="real %3R user %3U sys %3S"
+{ time aliroot -l -b -q -x "recCPass1.C(\"$CHUNKNAME\", $nEvents, \"$ocdbPath\", \"$triggerAlias\")" &> ../rec.log ; } 2> rectime.tmp
 exitcode=$?
+unset TIMEFORMAT
+cat rectime.tmp >&2
 timeEnd=`date +%s`
 timeUsed=$(( $timeUsed+$timeEnd-$timeStart ))
 delta=$(( $timeEnd-$timeStart ))
@@ -381,6 +384,12 @@ echo "recCPass1:  delta = $delta, timeUsed so far = $timeUsed"
 echo "recCPass1:  delta = $delta, timeUsed so far = $timeUsed" >&2
 parseRecLog ../rec.log
 
+# performance record of the reconstruction in telemetry.json/telemetry.csv
+read _ recReal _ recUser _ recSys < <(tail -n 1 rectime.tmp)
+rm -f rectime.tmp
+recWatch=$PWD/syswatch.log
+(cd .. && $ALIDPG_ROOT/DataProc/Common/stageTelemetry.sh "RECONSTRUCTION CPASS1" rec.log 1 $recWatch "$recReal" "$recUser" "$recSys" $exitcode)
+
 echo "Exit code: $exitcode"
 
 if [ $exitcode -ne 0 ]; then
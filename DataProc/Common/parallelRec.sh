@@ -0,0 +1,117 @@
+#!/bin/bash
+# Event-range parallel reconstruction of one raw chunk.
+# Sourced by runPPass.sh and runCPass0.sh: when recWorkers > 1 the events of the
+# chunk are split in recWorkers contiguous ranges, each one reconstructed in its
+# own rec_range_<i> directory against the OCDB.root snapshot (RECO_FIRSTEVENT and
+# RECO_LASTEVENT are read by the reconstruction macros), and the outputs are
+# merged back in the current directory with MergeShards.C, in the order of the
+# events, so that the following steps see the same files as after a serial job.
+#
+# options (environment, ALIEN_JDL_RECWORKERS takes precedence):
+#  recWorkers=N     number of concurrent reconstruction processes (default 1, serial)
+
+parallelRecWorkers()
+{
+  # set recWorkersUsed, the number of workers for chunk $1 (raw reader options $2),
+  # to 1 when the parallel reconstruction is not possible, and recEvents to the
+  # number of events to reconstruct; $3, if given, is the last event of the serial
+  # reconstruction (inclusive, SetEventRange(0,nevents) in main_recCPass0.C).
+  # The events are counted after the trigger selection of $2, the ranges are
+  # in the index of the selected events as for the reconstruction
+  recWorkersUsed=${ALIEN_JDL_RECWORKERS-$recWorkers}
+  recEvents=0
+  [[ ! $recWorkersUsed =~ ^[0-9]+$ || $recWorkersUsed -lt 2 ]] && recWorkersUsed=1 && return 0
+  if [[ "$OCDB_SNAPSHOT_CREATE" == "kTRUE" ]]; then
+    echo "parallel reconstruction: not used to create the OCDB snapshot"
+    recWorkersUsed=1 && return 0
+  fi
+  if [[ ! -f OCDB.root ]]; then
+    echo "parallel reconstruction: no OCDB.root snapshot to share, running serially"
+    recWorkersUsed=1 && return 0
+  fi
+  recEvents=$(aliroot -l -b -q -x "$ALIDPG_ROOT/DataProc/Common/rawEventCount.C(\"$1\", \"$2\")" 2>/dev/null | sed -n 's/^RAWEVENTS //p')
+  if [[ ! $recEvents =~ ^[0-9]+$ || $recEvents -lt 2 ]]; then
+    echo "parallel reconstruction: cannot get the number of events of $1, running serially"
+    recWorkersUsed=1 && return 0
+  fi
+  [[ -n "$3" && $3 -gt 0 && $3 -lt $recEvents ]] && recEvents=$(( $3+1 ))
+  [[ $recWorkersUsed -gt $recEvents ]] && recWorkersUsed=$recEvents
+  echo "parallel reconstruction: $recEvents events, $recWorkersUsed workers"
+}
+
+parallelRec()
+{
+  # reconstruct with $1 workers the $2 events with aliroot macro call $3, logs in $4
+  local workers=$1
+  local nevents=$2
+  local macro=$3
+  local log=$4
+  local ranges=""
+  local pids=()
+  local starts=()
+  local recStart=$(date +%s)
+
+  echo "parallel reconstruction: $nevents events in $workers ranges" | tee -a $log
+  for ((i=0; i<workers; i++)); do
+    local first=$(( i*nevents/workers ))
+    local last=$(( (i+1)*nevents/workers-1 ))
+    local dir=rec_range_$i
+    rm -rf $dir
+    mkdir $dir
+    # all the local inputs are shared by the workers; the logs and the files written
+    # by the reconstruction are not linked, the outputs stay in the range directory
+    for f in *; do
+      case $f in
+        rec_range_*|*.log|*.tmp|validation_error.message) continue ;;
+        galice.root|AliESD*.root|Run*.root|Trigger.root|*QA*.root) continue ;;
+        *.RecPoints.root) [[ $f != TPC.RecPoints.root ]] && continue ;;
+      esac
+      ln -s $PWD/$f $dir/.
+    done
+    echo "parallel reconstruction: events $first-$last in $dir" | tee -a $log
+    (
+      cd $dir
+      export RECO_FIRSTEVENT=$first
+      export RECO_LASTEVENT=$last
+      aliroot -l -b -q -x "$macro" &> rec.log
+    ) &
+    pids+=($!)
+    starts+=($(date +%s))
+    ranges="$ranges,$dir"
+  done
+  ranges=${ranges#,}
+
+  local exitcode=0
+  local workerTime=0
+  for i in "${!pids[@]}"; do
+    wait ${pids[$i]}
+    local code=$?
+    local end=$(date +%s)
+    workerTime=$(( workerTime+end-${starts[$i]} ))
+    echo "parallel reconstruction: rec_range_$i exited with code $code after $(( end-${starts[$i]} )) s" | tee -a $log
+    [[ $code -ne 0 ]] && exitcode=$code
+  done
+
+  # logs of all the ranges in the usual place, syswatch.log of the ranges one after the other
+  rm -f syswatch.log
+  for i in "${!pids[@]}"; do
+    echo "=== rec_range_$i ===" >> $log
+    cat rec_range_$i/rec.log >> $log
+    if [[ -f rec_range_$i/syswatch.log ]]; then
+      [[ -f syswatch.log ]] && tail -n +2 rec_range_$i/syswatch.log >> syswatch.log || cp rec_range_$i/syswatch.log syswatch.log
+    fi
+  done
+  [[ $exitcode -ne 0 ]] && return $exitcode
+
+  aliroot -l -b -q -x "$ALIDPG_ROOT/MC/MergeShards.C(\"$ranges\", kTRUE)" &> merge_ranges.log
+  exitcode=$?
+  cat merge_ranges.log >> $log
+  [[ $exitcode -ne 0 ]] && echo "parallel reconstruction: merging of the ranges failed" | tee -a $log && return $exitcode
+  rm -rf ${ranges//,/ }
+
+  local wall=$(( $(date +%s)-recStart ))
+  [[ $wall -lt 1 ]] && wall=1
+  echo "parallel reconstruction: $nevents events, $workers workers, wall $wall s, sum of worker times $workerTime s," \
+       "estimated speed-up $(awk "BEGIN {printf \"%.2f\", $workerTime/$wall}")" | tee -a $log
+  return 0
+}
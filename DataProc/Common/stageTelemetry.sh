@@ -0,0 +1,90 @@
+#!/bin/bash
+# Performance record of one processing stage, appended as one JSON line
+# to telemetry.json and as one row to telemetry.csv in the current directory.
+#
+# usage: stageTelemetry.sh <stage> <log> <firstLogLine> <syswatch> <wall> <cpuUser> <cpuSys> <exitCode> [events]
+#
+#  <log> from line <firstLogLine> on  - per-event CPU of the "End Event ... CPU x" lines
+#  <syswatch>                         - AliSysInfo syswatch.log of the stage, "" if none:
+#                                       peak/average RSS, bytes read and written, and the
+#                                       per-event CPU when the log has no event lines
+#                                       (simulation), from the CPU of the stamps per event
+#  <wall> <cpuUser> <cpuSys>          - times in seconds, as measured by the caller
+#  [events]                           - number of events when the log has no event lines
+#
+# values which cannot be measured are null (JSON) or empty (CSV)
+
+stage=$1
+log=$2
+firstLogLine=${3:-1}
+syswatch=$4
+wall=$5
+cpuUser=$6
+cpuSys=$7
+exitCode=$8
+events=$9
+
+# per-event CPU distribution from the reconstruction event lines
+read nEventLines cpuMean cpuMin cpuMedian cpuP90 cpuMax < <(
+  tail -n +$firstLogLine $log 2>/dev/null | \
+  sed -n 's/.*End Event.*CPU \([0-9.]*\) .*/\1/p' | sort -g | \
+  awk '{ v[NR]=$1; s+=$1 }
+       END { if (NR==0) { print 0; exit }
+             i50=int(0.5*(NR-1))+1; i90=int(0.9*(NR-1))+1
+             printf "%d %.4f %.4f %.4f %.4f %.4f\n", NR, s/NR, v[1], v[i50], v[i90], v[NR] }')
+[[ $nEventLines -gt 0 ]] && events=$nEventLines
+
+# otherwise from the syswatch stamps named after an event (...Event<n>...): the CPU of
+# event n is the cumulative process CPU of its last stamp minus that of the previous event
+if [[ $nEventLines -eq 0 && -n "$syswatch" && -f "$syswatch" ]]; then
+  read nEventLines cpuMean cpuMin cpuMedian cpuP90 cpuMax < <(
+    awk '
+      NR==1 { n=split($0, h, ":"); for (i=1; i<=n; i++) { sub("/.*", "", h[i]); col[h[i]]=i }; next }
+      !col["sname"] || !col["pI.fCpuUser"] || !col["pI.fCpuSys"] { exit }
+      match($col["sname"], /[Ee]vent_?[0-9]+/) {
+        ev=substr($col["sname"], RSTART, RLENGTH); gsub(/[^0-9]/, "", ev)
+        cpu=$col["pI.fCpuUser"]+$col["pI.fCpuSys"]
+        if (!(ev in last)) { order[++nev]=ev; first[ev]=cpu }
+        last[ev]=cpu }
+      END { for (i=1; i<=nev; i++) { ev=order[i]; print last[ev]-(i>1 ? last[order[i-1]] : first[ev]) } }' $syswatch |     sort -g |     awk '{ v[NR]=$1; s+=$1 }
+         END { if (NR==0) { print 0; exit }
+               i50=int(0.5*(NR-1))+1; i90=int(0.9*(NR-1))+1
+               printf "%d %.4f %.4f %.4f %.4f %.4f\n", NR, s/NR, v[1], v[i50], v[i90], v[NR] }')
+  [[ -z "$events" && $nEventLines -gt 0 ]] && events=$nEventLines
+fi
+
+# memory and I/O from the syswatch stamps, columns are taken from the header line
+read rssPeak rssAvg bytesRead bytesWritten < <(
+  [[ -n "$syswatch" && -f "$syswatch" ]] && awk '
+    NR==1 { n=split($0, h, ":"); for (i=1; i<=n; i++) { sub("/.*", "", h[i]); col[h[i]]=i }; next }
+    { if (col["pI.fMemResident"]) { r=$col["pI.fMemResident"]; if (r>peak) peak=r; sum+=r; nr++ }
+      if (col["fileBytesRead"] && $col["fileBytesRead"]>rd) rd=$col["fileBytesRead"]
+      if (col["fileBytesWritten"] && $col["fileBytesWritten"]>wr) wr=$col["fileBytesWritten"] }
+    END { printf "%s %s %s %s\n", nr ? sprintf("%.1f", peak) : "-", nr ? sprintf("%.1f", sum/nr) : "-",
+                                  col["fileBytesRead"] ? sprintf("%.0f", rd) : "-",
+                                  col["fileBytesWritten"] ? sprintf("%.0f", wr) : "-" }' $syswatch)
+
+cpu=$(awk "BEGIN {printf \"%.3f\", ${cpuUser:-0}+${cpuSys:-0}}")
+
+names=(stage host timestamp exitCode wallTime cpuTime cpuUser cpuSys rssPeakMB rssAvgMB bytesRead bytesWritten events cpuPerEventMean cpuPerEventMin cpuPerEventMedian cpuPerEventP90 cpuPerEventMax)
+values=("$stage" "$(hostname -f 2>/dev/null || hostname)" "$(date +%s)" "$exitCode" "$wall" "$cpu" "$cpuUser" "$cpuSys" "$rssPeak" "$rssAvg" "$bytesRead" "$bytesWritten" "$events" "$cpuMean" "$cpuMin" "$cpuMedian" "$cpuP90" "$cpuMax")
+
+json=""
+csv=""
+for ((i=0; i<${#names[@]}; i++)); do
+  value=${values[$i]}
+  [[ "$value" == "-" ]] && value=""
+  if [[ -z "$value" ]]; then
+    json="$json, \"${names[$i]}\": null"
+  elif [[ $i -lt 2 ]]; then
+    json="$json, \"${names[$i]}\": \"$value\""
+  else
+    json="$json, \"${names[$i]}\": $value"
+  fi
+  csv="$csv,$value"
+done
+
+echo "{${json#, }}" >> telemetry.json
+[[ -f telemetry.csv ]] || (IFS=,; echo "${names[*]}" > telemetry.csv)
+echo "${csv#,}" >> telemetry.csv
+echo "$stage TELEMETRY: {${json#, }}"
@@ -0,0 +1,176 @@
+#!/bin/bash
+# Tree merging of the CPass calibration outputs.
+# Sourced by mergeMakeOCDB.byComponent.perStage.sh when mergeMode=tree:
+#  - every bunch of files is merged as soon as it is downloaded, in the
+#    background, while the next bunch is being downloaded
+#  - all the components are merged in one pass over each file
+#  - the partial results are then merged together mergeFanIn at a time,
+#    level by level, with up to mergeWorkers concurrent merging processes
+#    (calibration objects are not thread safe, each merge is one aliroot)
+#
+# options (set on the command line of the calling script as option=value):
+#  mergeWorkers=N        max number of concurrent merging processes (default: ALIEN_JDL_CPUCORES, or 1)
+#  mergeFanIn=k          number of partial results merged together at each level (default 8)
+#  mergeMemoryLimit=MB   limit on the estimated memory of the concurrent merges (default 0, no limit)
+
+treeMergeInit()
+{
+  # the cores of the slot, not of the node which is shared with other jobs
+  [[ ! $mergeWorkers =~ ^[0-9]+$ || $mergeWorkers -lt 1 ]] && mergeWorkers=${ALIEN_JDL_CPUCORES-1}
+  [[ ! $mergeWorkers =~ ^[0-9]+$ || $mergeWorkers -lt 1 ]] && mergeWorkers=1
+  [[ ! $mergeFanIn =~ ^[0-9]+$ || $mergeFanIn -lt 2 ]] && mergeFanIn=8
+  [[ ! $mergeMemoryLimit =~ ^[0-9]+$ ]] && mergeMemoryLimit=0
+  treeMergeLeaves=0
+  treeMergeFilesTPC=$(cat $filesProcessedTPClist 2>/dev/null | wc -l)
+  rm -f tree_merge_failed tree_merge_dropped
+  echo "tree merging: workers=$mergeWorkers fanIn=$mergeFanIn memoryLimit=${mergeMemoryLimit}MB" | tee -a merge.log
+}
+
+treeMergeSlots()
+{
+  # number of merges allowed to run together: mergeWorkers, further limited by
+  # the memory limit given the largest input of the next merge ($1 = file list)
+  local slots=$mergeWorkers
+  if [[ $mergeMemoryLimit -gt 0 ]]; then
+    local largest=$(sed 's/#.*//' $1 | xargs ls -l 2>/dev/null | awk '{print $5}' | sort -n | tail -1)
+    local perMerge=$(( 3*${largest:-0}/1048576 + 1 ))
+    slots=$(( mergeMemoryLimit/perMerge ))
+    [[ $slots -gt $mergeWorkers ]] && slots=$mergeWorkers
+    [[ $slots -lt 1 ]] && slots=1
+  fi
+  echo $slots
+}
+
+treeMergeWait()
+{
+  # wait until fewer than $1 merging processes are running
+  while [[ $(jobs -rp | wc -l) -ge $1 ]]; do
+    wait -n 2>/dev/null || sleep 1
+  done
+}
+
+treeMergeJob()
+{
+  # merge the files in list $3 selecting components $2 into $1,
+  # in a dedicated running directory; $4=1 removes the inputs when done,
+  # failures are reported in file $5. When several components fail to
+  # merge together they are merged one by one into ${1%.root}_<component>.root,
+  # so that, as in the serial merging, only the failing ones are left out
+  local output=$1
+  local selection=$2
+  local fileList=$3
+  local removeInputs=$4
+  local failures=$5
+  local runningDirectory="${output%.root}.dir"
+
+  mkdir -p $runningDirectory
+  # file names without absolute path or protocol are relative to the parent directory
+  sed -e '/^[a-z]*:\/\//b' -e '/^\//b' -e 's|^|../|' $fileList > $runningDirectory/files.list
+  [[ -f mergeByComponent.C ]] && cp mergeByComponent.C $runningDirectory
+  cd $runningDirectory
+
+  aliroot -b -q "mergeByComponent.C(\"${selection}\", \"files.list\", 0, 0, 10, \"files.list\", \"CalibObjects.root\")" &> merge_tree.log
+  local mergeOK=0
+  [[ -f CalibObjects.root && -f ${selection}_merge_done ]] && ! grep -q "was a crash" merge_tree.log && mergeOK=1
+
+  cd ..
+  cat $runningDirectory/merge_tree.log >> ${output%.root}.log
+  [[ -f $runningDirectory/syswatch.log ]] && mv -f $runningDirectory/syswatch.log syswatch_${output%.root}.log
+  if [[ $mergeOK -eq 1 ]]; then
+    mv -f $runningDirectory/CalibObjects.root $output
+    [[ "$selection" == "ALL" ]] && mv -f $runningDirectory/ALL_merge_done .
+    # chunks merged for TPC, counted against maxChunksTPC as in the serial merging
+    [[ "$selection" =~ TPCCalib ]] && sed 's/#.*//' $fileList | grep "\.root" >> $filesProcessedTPClist
+  elif [[ "$selection" =~ , ]]; then
+    echo "### tree merging of $fileList into $output not validated, merging the components one by one" >> ${output%.root}.log
+    rm -rf $runningDirectory
+    for det in ${selection//,/ }; do
+      treeMergeJob ${output%.root}_${det}.root $det $fileList 0 $failures
+    done
+  else
+    echo "### tree merging of $fileList ($selection) into $output not validated" | tee -a $failures
+  fi
+  if [[ $removeInputs -eq 1 ]]; then
+    sed 's/#.*//' $fileList | grep -v "://" | xargs rm -f
+  fi
+  rm -rf $runningDirectory
+}
+
+treeMergeLeaf()
+{
+  # start merging a freshly downloaded bunch ($1 = local file list, $2 = cleanup)
+  # only the files actually downloaded are merged and counted, as in mergeByComponent
+  local fileList=$1.present
+  local entry
+  : > $fileList
+  while read entry; do
+    [[ $entry =~ ^.*\.root$ && -f ${entry%#*} ]] && echo "$entry" >> $fileList
+  done < $1
+  local nFiles=$(grep -c "\.root" $fileList)
+  [[ $nFiles -lt 1 ]] && echo "no new files in ${fileList}" && return 0
+
+  # TPC only up to maxChunksTPC chunks merged successfully: treeMergeFilesTPC
+  # counts the chunks merged or being merged, when it reaches the limit the
+  # running merges are waited for and the chunks actually merged are counted
+  if [[ $treeMergeFilesTPC -ge $maxChunksTPC ]]; then
+    wait
+    treeMergeFilesTPC=$(cat $filesProcessedTPClist 2>/dev/null | wc -l)
+  fi
+
+  # all the components at once
+  local selection=""
+  for det in $components; do
+    if [[ "${det}" =~ TPC && $treeMergeFilesTPC -ge $maxChunksTPC ]]; then
+      echo "Not merging TPC anymore, max number of chunks processed ($maxChunksTPC)"
+      continue
+    fi
+    selection="${selection},${det}"
+  done
+  selection=${selection#,}
+  [[ "$selection" =~ TPCCalib ]] && treeMergeFilesTPC=$((treeMergeFilesTPC+nFiles))
+
+  local leaf=$(printf "CalibObjects_tree_0_%06d.root" $treeMergeLeaves)
+  ((treeMergeLeaves++))
+  echo "tree merging: $fileList ($nFiles files, $selection) -> $leaf" | tee -a merge.log
+  treeMergeWait $(treeMergeSlots $fileList)
+  treeMergeJob $leaf "$selection" $fileList $2 tree_merge_dropped &
+}
+
+treeMergeReduce()
+{
+  # merge the partial results level by level into CalibObjects.root
+  wait
+  local level=0
+  [[ -f tree_merge_dropped ]] && cat tree_merge_dropped | tee -a merge.log
+  local partials=($(ls -1 CalibObjects_tree_0_*.root 2>/dev/null))
+  if [[ ${#partials[@]} -eq 0 ]]; then
+    echo "tree merging: no partial results to merge" | tee -a merge.log
+    return 1
+  fi
+
+  while [[ ${#partials[@]} -gt 1 || $level -eq 0 ]]; do
+    ((level++))
+    local group=0
+    for ((i=0; i<${#partials[@]}; i+=mergeFanIn)); do
+      local groupList=$(printf "tree_%d_%06d.list" $level $group)
+      printf "%s\n" "${partials[@]:i:mergeFanIn}" > $groupList
+      treeMergeWait $(treeMergeSlots $groupList)
+      treeMergeJob $(printf "CalibObjects_tree_%d_%06d.root" $level $group) ALL $groupList 1 tree_merge_failed &
+      ((group++))
+    done
+    wait
+    rm -f tree_${level}_*.list
+    if [[ -f tree_merge_failed ]]; then
+      cat tree_merge_failed | tee -a merge.log
+      return 1
+    fi
+    partials=($(ls -1 CalibObjects_tree_${level}_*.root 2>/dev/null))
+    echo "tree merging: level $level done, ${#partials[@]} partial results" | tee -a merge.log
+  done
+
+  mv -f ${partials[0]} CalibObjects.root
+  cat CalibObjects_tree_*.log >> merge.log 2>/dev/null
+  rm -f CalibObjects_tree_*.log
+
+  return 0
+}
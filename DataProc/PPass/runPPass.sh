@@ -232,6 +232,14 @@ if [ "$pass_type" == "ppass" ] && [ "$preclusterizeTPC" = "1" ] && [ "$OCDB_SNAP
 fi
 
 
+# event-range parallel reconstruction of the chunk, if requested (recWorkers)
+source $ALIDPG_ROOT/DataProc/Common/parallelRec.sh
+recWorkersUsed=1
+if [ -z "$RECO_ARGS" ]; then
+    [ -f "$CHUNKNAME" ] && [ "${CHUNKNAME:0:1}" != "/" ] && CHUNKNAME="`pwd`/$CHUNKNAME"
+    parallelRecWorkers "$CHUNKNAME" ""
+fi
+
 echo "* Running AliRoot to reconstruct '$CHUNKNAME', extra arguments are '$RECO_ARGS' and run number is $runnum ..."
 echo ""
 echo "running the following rec.C macro:"
@@ -241,7 +249,11 @@ echo executing aliroot -l -b -q -x "rec.C(\"$CHUNKNAME\"$RECO_ARGS)"
 echo "" >&2
 echo "rec.C" >&2
 timeStart=`date +%s`
-time aliroot -l -b -q -x "rec.C(\"$CHUNKNAME\"$RECO_ARGS)" &> rec.log
+if [ "$recWorkersUsed" -gt 1 ]; then
+    time parallelRec $recWorkersUsed $recEvents "rec.C(\"$CHUNKNAME\")" rec.log
+else
+    time aliroot -l -b -q -x "rec.C(\"$CHUNKNAME\"$RECO_ARGS)" &> rec.log
+fi
 
 exitcode=$?
 timeEnd=`date +%s`
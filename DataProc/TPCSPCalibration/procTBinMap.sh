@@ -7,11 +7,23 @@
 # 2) end time
 # 3) run number
 # 4) optional number of tracks for closure test (if requested)
+#
+# with "all" as first argument, the maps of all time bins of the run listed
+# in the time bins file (as written by procVDTime.sh) are extracted in one go,
+# the remote residual trees being copied once (as long as the free disk space
+# stays above distStageReserveMB, default 2000) and the bins processed in
+# parallel by distNWorkers workers (default: ALIEN_JDL_CPUCORES, or 1); each
+# bin still reads the full residual tree list
+# arguments:
+# 1) all
+# 2) time bins file
+# 3) run number
 
 
 ##############################################################################
 Usage() {
     echo "Usage: ${0##*/} <minTime> <maxTime> <runNumber> [ntracks_closure_test]"
+    echo "   or: ${0##*/} all <timeBinsFile> <runNumber>"
     exit 1
 }
 
@@ -57,6 +69,11 @@ extractEnvVars()
     #
     # extract correction map for MC (must be undefined or "true" or "false"
     export distCreateDistortion=${ALIEN_JDL_DISTCREATEDISTORTION-$distCreateDistortion}
+    #
+    # number of parallel workers when processing all time bins at once
+    # (every worker holds a copy of the calibration object, one per core of the slot)
+    export distNWorkers=${ALIEN_JDL_DISTNWORKERS-${distNWorkers-${ALIEN_JDL_CPUCORES-1}}}
+    export distStageReserveMB=${ALIEN_JDL_DISTSTAGERESERVEMB-$distStageReserveMB}
     
     echo ""
     echo "Listing all env.vars"
@@ -95,6 +112,27 @@ locMacro=$(basename "$macroName")
 extractEnvVars
 
 run=$(echo "$runNumber" | sed 's/^0*//')
+
+if [[ "$mapStartTime" == "all" ]] ; then
+    timeBinsFile=$mapStopTime
+    [[ ! -f $timeBinsFile ]] && alilog_info "Error: time bins file $timeBinsFile not found" && exit -1
+    alilog_info "BEGIN Processing all time bins of $timeBinsFile in run $runNumber"
+    mode=4
+    time aliroot -b -q  $inclMacro $loadLibMacro ${locMacro}+g\($mode,$run,0,0x7fffffff,\"$timeBinsFile\"\) >& out_all.log
+    error=$?
+    alilog_info "END: Processing"
+    grep "processed .* time bins" out_all.log
+    # a failed time bin fails the job, also when aliroot itself exits with 0
+    nFailed=$(sed -n 's/^StatInfo.NTBinFailed\t//p' out_all.log)
+    if [[ $error -eq 0 && "$nFailed" != "0" ]]; then
+        alilog_info "Error: ${nFailed:-unknown number of} time bins failed"
+        error=1
+    fi
+    rm -rf residuals residual_staged.list
+    [[ $error -ne 0 ]] && exit $error
+    exit 0
+fi
+
 alilog_info "BEGIN Processing for time bin $mapStartTime : $mapStopTime in run $runNumber"
 mode=2
 time aliroot -b -q  $inclMacro $loadLibMacro ${locMacro}+g\($mode,$run,$mapStartTime,$mapStopTime,\"\"\) >& out_${mapStartTime}_${mapStopTime}.log
@@ -0,0 +1,137 @@
+/*
+ * AliDPG - ALICE Experiment Data Preparation Group
+ * Compiled configuration library, common declarations
+ *
+ * Headers of the configuration macros and the declarations shared by
+ * ConfigLibrary.C and the custom generator units written by
+ * LoadConfigLibrary.C, so that the generators see the same classes.
+ *
+ */
+
+#ifndef ALIDPG_CONFIGLIBRARY_H
+#define ALIDPG_CONFIGLIBRARY_H
+
+#if !(defined(__CLING__)  || defined(__CINT__)) || defined(__ROOTCLING__) || defined(__ROOTCINT__)
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TMath.h"
+#include "TString.h"
+#include "TObjString.h"
+#include "TObjArray.h"
+#include "TFile.h"
+#include "TF1.h"
+#include "TFormula.h"
+#include "TDatime.h"
+#include "TGrid.h"
+#include "TStopwatch.h"
+#include "TVirtualMC.h"
+#include "TVirtualMCDecayer.h"
+#include "TGeant3TGeo.h"
+#include "AliRun.h"
+#include "AliMC.h"
+#include "AliConfig.h"
+#include "AliRunLoader.h"
+#include "AliPDG.h"
+#include "AliDAQ.h"
+#include "AliMagF.h"
+#include "AliModule.h"
+#include "AliSimulation.h"
+#include "AliReconstruction.h"
+#include "AliReconstructor.h"
+#include "AliRecoParam.h"
+#include "AliMCEventHandler.h"
+#include "AliCDBManager.h"
+#include "AliCDBStorage.h"
+#include "AliCDBEntry.h"
+#include "AliCDBMetaData.h"
+#include "AliCDBId.h"
+#include "AliGRPObject.h"
+#include "AliITSRecoParam.h"
+#include "AliITStrackerMI.h"
+#include "AliTPCRecoParam.h"
+#include "AliPHOSSimParam.h"
+#include "AliBODY.h"
+#include "AliMAG.h"
+#include "AliABSOv3.h"
+#include "AliDIPOv3.h"
+#include "AliHALLv3.h"
+#include "AliFRAMEv2.h"
+#include "AliFRAMEv3.h"
+#include "AliSHILv3.h"
+#include "AliPIPEv3.h"
+#include "AliITSv11.h"
+#include "AliTPCv2.h"
+#include "AliTOFv6T0.h"
+#include "AliHMPIDv3.h"
+#include "AliZDCv3.h"
+#include "AliZDCv4.h"
+#include "AliTRDv1.h"
+#include "AliTRDgeometry.h"
+#include "AliTRDtestG4.h"
+#include "AliFMDv1.h"
+#include "AliMUONv1.h"
+#include "AliPHOSv1.h"
+#include "AliPMDv1.h"
+#include "AliT0v1.h"
+#include "AliEMCALv2.h"
+#include "AliACORDEv1.h"
+#include "AliVZEROv7.h"
+#include "AliADv1.h"
+#include "AliMFT.h"
+#include "AliFITv7.h"
+#include "AliDecayer.h"
+#include "AliDecayerPythia.h"
+#include "AliGenerator.h"
+#include "AliGenCocktail.h"
+#include "AliGenParam.h"
+#include "AliGenBox.h"
+#include "AliGenPHOSlib.h"
+#include "AliGenEMlib.h"
+#include "AliGenMUONlib.h"
+#include "AliGenExtFile.h"
+#include "AliGenExtExec.h"
+#include "AliGenReaderHepMC.h"
+#include "AliGenPythia.h"
+#include "AliGenPythiaPlus.h"
+#include "AliPythia.h"
+#include "AliPythia8.h"
+#include "AliGenDPMjet.h"
+#include "AliGenHijing.h"
+#include "AliGenAmpt.h"
+#include "AliGenStarLight.h"
+#include "AliGenDRgen.h"
+#include "AliGenDime.h"
+#include "AliGenEvtGen.h"
+#include "AliGenSLEvtGen.h"
+#include "AliGenQEDBg.h"
+#include "AliGenPerformance.h"
+#include <map>
+#endif
+
+#define ALIDPG_CONFIGLIBRARY
+
+/*****************************************************************/
+
+// call a custom generator with its option, whatever its signature
+
+template <typename R>
+AliGenerator *ConfigLibraryCall(R *(*generator)(TString), const TString &opt)
+{
+  return generator(opt);
+}
+
+template <typename R>
+AliGenerator *ConfigLibraryCall(R *(*generator)(), const TString &opt)
+{
+  printf(">>>>> WARNING: generator does not take options, ignoring \"%s\" \n", opt.Data());
+  return generator();
+}
+
+// a custom generator unit creates the generator and returns the comment
+// it appended to the generator configuration
+typedef AliGenerator *(*ConfigLibraryGeneratorFactory_t)(const TString *opt, TString &cmt);
+
+Bool_t ConfigLibraryRegisterGenerator(const Char_t *name, ConfigLibraryGeneratorFactory_t factory);
+AliGenerator *ConfigLibraryGenerator(const Char_t *name, const TString *opt);
+
+#endif
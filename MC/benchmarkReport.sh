@@ -0,0 +1,75 @@
+#!/bin/bash
+# Report of the generator benchmark suite (make benchmark in MC/Makefile):
+# collects the telemetry.csv of every benchmark directory into one report
+# and compares it to a stored baseline.
+#
+# usage: benchmarkReport.sh <report.csv> <baseline.csv> <tolerance%> <directory>...
+#
+# a (generator, stage) is a regression when one of its cpuTime, cpuPerEventMean,
+# rssPeakMB or bytesWritten exceeds the baseline by more than tolerance%,
+# the exit code is the number of regressions and failed generators
+
+REPORT=$1
+BASELINE=$2
+TOLERANCE=${3:-10}
+shift 3
+
+METRICS="cpuTime cpuPerEventMean rssPeakMB bytesWritten"
+
+### collect the stage records, one row per generator and stage
+
+rm -f $REPORT
+NFAILED=0
+for DIR in "$@"; do
+    GEN=${DIR#benchmark/}
+    GEN=${GEN//\//:}
+    if [ ! -f $DIR/telemetry.csv ]; then
+	echo "*! $GEN: no telemetry, benchmark failed"
+	NFAILED=$((NFAILED+1))
+	continue
+    fi
+    [ -f $REPORT ] || echo "generator,$(head -n 1 $DIR/telemetry.csv)" > $REPORT
+    tail -n +2 $DIR/telemetry.csv | sed "s|^|$GEN,|" >> $REPORT
+    [ -f $DIR/validation_error.message ] && echo "*! $GEN: $(head -n 1 $DIR/validation_error.message)" && NFAILED=$((NFAILED+1))
+done
+
+if [ ! -f $REPORT ]; then
+    echo "*! no benchmark results"
+    exit 1
+fi
+
+echo "=== Benchmark report $REPORT ==="
+awk -F, 'NR==1 { for (i=1; i<=NF; i++) col[$i]=i
+                 printf "%-40s %-24s %10s %10s %10s %12s %8s\n", "generator", "stage", "wall [s]", "cpu [s]", "RSS [MB]", "cpu/ev [s]", "events"; next }
+         { printf "%-40s %-24s %10s %10s %10s %12s %8s\n", $col["generator"], $col["stage"], $col["wallTime"], $col["cpuTime"],
+                  $col["rssPeakMB"], $col["cpuPerEventMean"], $col["events"] }' $REPORT
+
+### comparison to the baseline
+
+if [ ! -f $BASELINE ]; then
+    echo "=== No baseline $BASELINE, record one with 'make benchmark-baseline' ==="
+    exit $NFAILED
+fi
+
+echo "=== Comparison to the baseline $BASELINE (tolerance $TOLERANCE%) ==="
+COMPARISON=$(awk -F, -v tolerance=$TOLERANCE -v metrics="$METRICS" '
+  FNR==1 { for (i=1; i<=NF; i++) col[FILENAME, $i]=i; next }
+  FILENAME==ARGV[1] { for (m in wanted) base[$col[FILENAME, "generator"] "|" $col[FILENAME, "stage"], m]=$col[FILENAME, m]
+                      seen[$col[FILENAME, "generator"] "|" $col[FILENAME, "stage"]]=1; next }
+  { key=$col[FILENAME, "generator"] "|" $col[FILENAME, "stage"]
+    if (!(key in seen)) { printf "  %-64s new, not in the baseline\n", key; next }
+    for (m in wanted) {
+      b=base[key, m]; v=$col[FILENAME, m]
+      if (b=="" || v=="" || b+0<=0) continue
+      change=100*(v-b)/b
+      flag=(change>tolerance) ? "REGRESSION" : ((change<-tolerance) ? "improvement" : "")
+      if (flag=="REGRESSION") n++
+      if (flag!="") printf "  %-64s %-16s %12s -> %12s (%+.1f%%) %s\n", key, m, b, v, change, flag
+    } }
+  BEGIN { split(metrics, list, " "); for (i in list) wanted[list[i]]=1 }
+  END { print n+0 }' $BASELINE $REPORT)
+echo "$COMPARISON" | sed '$d'
+NREGRESSIONS=$(echo "$COMPARISON" | tail -n 1)
+
+echo "=== $NREGRESSIONS regressions, $NFAILED failed generators ==="
+exit $((NREGRESSIONS+NFAILED))
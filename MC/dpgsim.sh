@@ -18,7 +18,7 @@ $ALIDPG_ROOT/DataProc/Common/EnableVDTUponPackageVersion.sh
 ###################
 
 # set job and simulation variables as :
-COMMAND_HELP="./dpgsim.sh --mode <mode> --run <run> --generator <generatorConfig> --energy <energy> --system <system> --detector <detectorConfig> --magnet <magnetConfig> --simulation <simulationConfig> --reconstruction <reconstructionConfig> --uid <uniqueID> --nevents <numberOfEvents> --qa <qaConfig> --aod <aodConfig> --ocdb <ocdbConfig> --hlt <hltConfig> --keepTrackRefsFraction <percentage> --ocdbCustom --purifyKineOff"
+COMMAND_HELP="./dpgsim.sh --mode <mode> --run <run> --generator <generatorConfig> --energy <energy> --system <system> --detector <detectorConfig> --magnet <magnetConfig> --simulation <simulationConfig> --reconstruction <reconstructionConfig> --uid <uniqueID> --nevents <numberOfEvents> --qa <qaConfig> --aod <aodConfig> --ocdb <ocdbConfig> --hlt <hltConfig> --keepTrackRefsFraction <percentage> --ocdbCustom --purifyKineOff --workers <numberOfWorkers> --configLibrary <directory> --background <background> --nbkg <numberOfBackgroundEvents> --backgroundPool <directory> --backgroundPoolSize <numberOfEntries> --backgroundPoolMaxSize <GB> --checkESDWorkers <numberOfWorkers> --checkESDFraction <fraction>"
 
 function runcommand(){
     echo -e "\n"
@@ -29,11 +29,31 @@ function runcommand(){
     echo "* $1 : $2" >&2
     echo "* $1 : output log in $3" >&2
 
+    # the stages using the configuration macros run on top of the configuration library, if any
+    PRELOAD=""
+    if [[ -n "$CONFIG_CONFIGLIBRARY" && "$1" =~ ^(SIMULATION|RECONSTRUCTION|BACKGROUND|OCDB SIM SNAPSHOT|OCDB REC SNAPSHOT|CHECK ESD|QA TRAIN|AOD TRAIN) ]]; then
+	PRELOAD=$ALIDPG_ROOT/MC/LoadConfigLibrary.C
+    fi
+
+    LOGLINES=$(cat $3 2>/dev/null | wc -l)
     START=`date "+%s"`
-    time aliroot -b -q -x $2 >>$3 2>&1
+    export CONFIG_STAGESTART=`date "+%s.%N"`
+    local TIMEFORMAT="real %3R user %3U sys %3S"
+    { time aliroot -b -q -x $PRELOAD $2 >>$3 2>&1 ; } 2> stagetime.tmp
     exitcode=$?
     END=`date "+%s"`
+    cat stagetime.tmp >&2
     echo "$1 TIME: $((END-START))"
+    tail -n +$((LOGLINES+1)) $3 | grep "^>>>>> timing:" | sed "s/^>>>>> timing:/$1 TIMING:/"
+
+    # performance record of the stage in telemetry.json/telemetry.csv
+    read _ STAGEREAL _ STAGEUSER _ STAGESYS < <(tail -n 1 stagetime.tmp)
+    rm -f stagetime.tmp
+    STAGEWATCH=""
+    [[ $(stat -c %Y syswatch.log 2>/dev/null || echo 0) -ge $START ]] && STAGEWATCH=syswatch.log
+    STAGEEVENTS=""
+    [[ "$1" =~ ^(SIMULATION|RECONSTRUCTION|BACKGROUND) ]] && STAGEEVENTS=$CONFIG_NEVENTS
+    $ALIDPG_ROOT/DataProc/Common/stageTelemetry.sh "$1" $3 $((LOGLINES+1)) "$STAGEWATCH" "$STAGEREAL" "$STAGEUSER" "$STAGESYS" $exitcode $STAGEEVENTS
 
     expectedCode=${5-0}
 
@@ -68,6 +88,110 @@ function runcommand(){
 
 }
 
+function runshards(){
+    # split CONFIG_NEVENTS in CONFIG_WORKERS event shards, each one running
+    # $1 (sim) and then $2 (rec) in its own shard_N directory with its own seed,
+    # concurrently, and merge the outputs back in the current directory
+
+    SHARDS=""
+    SHARDPIDS=()
+    for ((ISHARD=0; ISHARD<CONFIG_WORKERS; ISHARD++)); do
+
+	SHARDNEV=$((CONFIG_NEVENTS/CONFIG_WORKERS))
+	[[ $ISHARD -lt $((CONFIG_NEVENTS%CONFIG_WORKERS)) ]] && SHARDNEV=$((SHARDNEV+1))
+	[[ $SHARDNEV -eq 0 ]] && continue
+
+	# the first shard keeps the job seed, a 1-worker job is identical to a serial one;
+	# the others get a hash of (job seed, shard) in [1000000000, 2147483647), above
+	# the job seeds (< 1000000000) so never the seed of another job, and never 0
+	SHARDSEED=$CONFIG_SEED
+	if [ $ISHARD -gt 0 ]; then
+	    SHARDHASH=$(echo "$CONFIG_SEED $ISHARD" | md5sum | cut -c1-8)
+	    SHARDSEED=$((1000000000+16#$SHARDHASH%1147483647))
+	fi
+	SHARDDIR=shard_$ISHARD
+
+	rm -rf $SHARDDIR
+	mkdir $SHARDDIR
+	# all the job inputs are linked (the macros and configurations copied), the
+	# logs and the files written by the simulation and the reconstruction are not
+	for I in *; do
+	    case $I in
+		shard_*|*.log|*.tmp|validation_error.message|telemetry.json|telemetry.csv) continue ;;
+		*.C|*.cfg) cp $I $SHARDDIR/. ; continue ;;
+		galice.root|Kinematics*.root|TrackRefs*.root|*.Hits.root|*.SDigits.root|*.Digits.root|*.RecPoints.root) continue ;;
+		AliESD*.root|Run*.root|Trigger.root|*QA*.root|*.tag.root) continue ;;
+	    esac
+	    ln -s $PWD/$I $SHARDDIR/.
+	done
+
+	echo "* SHARD $ISHARD : $SHARDNEV events, seed $SHARDSEED, in $SHARDDIR"
+	(
+	    cd $SHARDDIR
+	    export CONFIG_NEVENTS=$SHARDNEV
+	    export CONFIG_SEED=$SHARDSEED
+	    runcommand "SIMULATION SHARD $ISHARD" $1 sim.log 5
+	    mv -f syswatch.log simwatch.log
+	    runcommand "RECONSTRUCTION SHARD $ISHARD" $2 rec.log 10
+	    mv -f syswatch.log recwatch.log
+	) > $SHARDDIR/shard.log 2>&1 &
+
+	SHARDPIDS+=($!)
+	SHARDS="$SHARDS,$SHARDDIR"
+    done
+    SHARDS=${SHARDS#,}
+
+    SHARDERROR=0
+    for I in "${!SHARDPIDS[@]}"; do
+	wait ${SHARDPIDS[$I]}
+	exitcode=$?
+	cat shard_$I/shard.log
+	if [ "$exitcode" -ne "0" ]; then
+	    [ -f shard_$I/validation_error.message ] && cat shard_$I/validation_error.message >> validation_error.message
+	    SHARDERROR=$exitcode
+	fi
+    done
+
+    # keep the logs of all shards in the usual place
+    for LOG in sim.log rec.log; do
+	for I in ${SHARDS//,/ }; do
+	    echo "=== $I ===" >> $LOG
+	    cat $I/$LOG >> $LOG 2>/dev/null
+	done
+    done
+    for I in ${SHARDS//,/ }; do
+	for LOG in simwatch.log recwatch.log; do
+	    [ -f $I/$LOG ] && mv -f $I/$LOG ${LOG%.log}_$I.log
+	done
+	[ -f $I/telemetry.json ] && cat $I/telemetry.json >> telemetry.json
+	if [ -f $I/telemetry.csv ]; then
+	    [ -f telemetry.csv ] || head -n 1 $I/telemetry.csv > telemetry.csv
+	    tail -n +2 $I/telemetry.csv >> telemetry.csv
+	fi
+    done
+
+    if [ "$SHARDERROR" -ne "0" ]; then
+	echo "*! one or more shards failed, the last one with exitcode $SHARDERROR"
+	exit $SHARDERROR
+    fi
+
+    # all the ROOT outputs are merged, per-event files renumbered
+    runcommand "MERGE SHARDS" $ALIDPG_ROOT/MC/MergeShards.C\(\"$SHARDS\",kTRUE,kTRUE\) merge.log 15
+
+    # of the other files only the inputs copied or linked above and the logs and
+    # telemetry collected above are dropped, anything else is kept as shard_<i>_<file>
+    for I in ${SHARDS//,/ }; do
+	for F in $(ls -A $I); do
+	    [ -L $I/$F ] && continue
+	    case $F in
+		*.root|*.C|*.cfg|sim.log|rec.log|shard.log|telemetry.json|telemetry.csv|stagetime.tmp) ;;
+		*) mv -f $I/$F ${I}_$F ;;
+	    esac
+	done
+    done
+    rm -rf ${SHARDS//,/ }
+}
+
 function runBenchmark(){
     if [ ! -x "$ROOTSYS/test/stressHepix" ]; then
         (cd "$ROOTSYS/test" && make) &>/dev/null
@@ -112,6 +236,137 @@ function runBenchmark(){
     fi
 }
 
+function unzipBackground(){
+    # extract from background archive $1 into $2 only what embedding reads,
+    # the hits and the reconstruction outputs stay in the archive, except
+    # the T0 hits which the T0 digitiser reads (as in the EmbedBkg cleanup)
+    unzip -o -q $1 -d $2 -x '*.Hits.root' 'AliESD*.root' '*.RecPoints.root' '*QA*.root' '*.log' || return 1
+    if unzip -Z1 $1 | grep -q "^T0.Hits.root$"; then
+	unzip -o -q $1 T0.Hits.root -d $2 || return 1
+    fi
+}
+
+function backgroundPool(){
+    # point CONFIG_BACKGROUND to entry CONFIG_BKGINDEX of the background pool
+    # CONFIG_BKGPOOL/<run>/<background>/<index>, building the entry first when
+    # it does not exist yet; entries are built once under a lock and then
+    # read concurrently by all the signal jobs, which do not modify them.
+    # An AliEn background has a single entry (index 0) per source path. The
+    # entries only hold the background files, the logs and telemetry of the
+    # build stay in the BKGPOOL directory of the job
+
+    BKGTAG=${CONFIG_BACKGROUND%galice.root}
+    BKGTAG=${BKGTAG%/}
+    BKGTAG=$(echo ${BKGTAG#alien://} | sed 's|[^A-Za-z0-9_.-]|_|g')
+    [[ $CONFIG_BACKGROUND != *galice.root ]] && BKGTAG=${BKGTAG}_nbkg${CONFIG_NBKG}
+    BKGENTRY=$CONFIG_BKGPOOL/$CONFIG_RUN/$BKGTAG/$CONFIG_BKGINDEX
+    BKGBUILD=$PWD/BKGPOOL
+
+    mkdir -p $CONFIG_BKGPOOL/$CONFIG_RUN/$BKGTAG
+    # the entry is in use until the job ends, it cannot be evicted meanwhile
+    exec 7> $BKGENTRY.use
+    flock -s 7
+    (
+	flock -x 9
+	if [ -f $BKGENTRY/.ready ]; then
+	    echo ">>>>> BACKGROUND POOL: reusing $BKGENTRY"
+	    touch $BKGENTRY/.ready
+	    exit 0
+	fi
+
+	echo ">>>>> BACKGROUND POOL: building $BKGENTRY"
+	rm -rf $BKGENTRY
+	mkdir -p $BKGENTRY
+
+	if [[ $CONFIG_BACKGROUND == alien://* ]]; then
+	    # already simulated background, archives copied and extracted once
+	    alien_cp ${CONFIG_BACKGROUND%galice.root}/*.zip $BKGENTRY/. || exit 1
+	    for I in $BKGENTRY/*.zip; do
+		unzipBackground $I $BKGENTRY && rm $I || exit 1
+	    done
+	else
+	    # background generated here, as the on-the-fly embedding does in BKG,
+	    # only the simulation outputs are moved to the entry
+	    rm -rf $BKGBUILD
+	    mkdir $BKGBUILD
+	    cp OCDB*.root *.C $BKGBUILD/. &>/dev/null
+	    cd $BKGBUILD
+	    export CONFIG_GENERATOR=$CONFIG_BACKGROUND
+	    export CONFIG_NEVENTS=$CONFIG_NBKG
+	    export CONFIG_SIMULATION="EmbedBkg"
+	    export CONFIG_BGEVDIR=""
+	    runcommand "BACKGROUND POOL" $1 sim.log 5
+	    mv -f syswatch.log simwatch.log
+	    for F in *; do
+		case $F in
+		    OCDB*.root|*.C|*.log|*.tmp|telemetry.*|validation_error.message) ;;
+		    *) mv $F $BKGENTRY/. ;;
+		esac
+	    done
+	    cd ..
+	fi
+
+	[ -f $BKGENTRY/galice.root ] || exit 1
+	BKGEVENTS=$(root -b -q -l -e 'TFile f("'$BKGENTRY'/galice.root"); TTree *t = (TTree *)f.Get("TE"); printf("EVENTS %lld\n", t ? t->GetEntries() : 0LL);' 2>/dev/null | sed -n 's/^EVENTS //p')
+	touch $BKGENTRY/.ready
+	(
+	    flock -x 8
+	    echo "$CONFIG_RUN $BKGTAG $CONFIG_BKGINDEX ${BKGEVENTS:-0} $BKGENTRY" >> $CONFIG_BKGPOOL/index.txt
+	    backgroundPoolEvict
+	) 8> $CONFIG_BKGPOOL/.index.lock
+    ) 9> $BKGENTRY.lock
+    BKGPOOLEXIT=$?
+
+    # telemetry and errors of the build with the ones of the job
+    if [ -d $BKGBUILD ]; then
+	[ -f $BKGBUILD/validation_error.message ] && cat $BKGBUILD/validation_error.message >> validation_error.message
+	[ -f $BKGBUILD/telemetry.json ] && cat $BKGBUILD/telemetry.json >> telemetry.json
+	if [ -f $BKGBUILD/telemetry.csv ]; then
+	    [ -f telemetry.csv ] || head -n 1 $BKGBUILD/telemetry.csv > telemetry.csv
+	    tail -n +2 $BKGBUILD/telemetry.csv >> telemetry.csv
+	fi
+	rm -f $BKGBUILD/OCDB*.root $BKGBUILD/*.C $BKGBUILD/telemetry.* $BKGBUILD/validation_error.message
+    fi
+
+    if [ "$BKGPOOLEXIT" -ne "0" ]; then
+	echo "*! background pool entry $BKGENTRY could not be built"
+	echo "background pool entry $BKGENTRY could not be built" >> validation_error.message
+	exit 5
+    fi
+
+    export OVERRIDE_BKG_PATH_RECORD=$CONFIG_BACKGROUND
+    export CONFIG_BACKGROUND=$BKGENTRY/galice.root
+}
+
+function backgroundPoolEvict(){
+    # with a size limit (CONFIG_BKGPOOLMAXSIZE, GB), remove the least recently
+    # used entries of the pool until it fits; the entries in use by a job
+    # (shared lock on <entry>.use) are never removed. Called under the index lock
+
+    [[ $CONFIG_BKGPOOLMAXSIZE -gt 0 ]] || return 0
+    local LIMIT=$((CONFIG_BKGPOOLMAXSIZE*1024*1024))
+    local SIZE=$(du -sk --exclude=index.txt $CONFIG_BKGPOOL 2>/dev/null | cut -f1)
+    local ENTRY
+    for ENTRY in $(ls -1tr $CONFIG_BKGPOOL/*/*/*/.ready 2>/dev/null); do
+	[[ ${SIZE:-0} -le $LIMIT ]] && break
+	ENTRY=${ENTRY%/.ready}
+	(
+	    flock -xn 6 || exit 1
+	    flock -xn 5 || exit 1
+	    ENTRYSIZE=$(du -sk $ENTRY | cut -f1)
+	    rm -rf $ENTRY
+	    grep -v " $ENTRY\$" $CONFIG_BKGPOOL/index.txt > $CONFIG_BKGPOOL/index.txt.tmp
+	    mv -f $CONFIG_BKGPOOL/index.txt.tmp $CONFIG_BKGPOOL/index.txt
+	    echo ">>>>> BACKGROUND POOL: evicted $ENTRY (${ENTRYSIZE} kB)"
+	    echo $ENTRYSIZE >&4
+	) 6> $ENTRY.use 5> $ENTRY.lock 4> $CONFIG_BKGPOOL/.evicted
+	[[ -s $CONFIG_BKGPOOL/.evicted ]] && SIZE=$((SIZE-$(cat $CONFIG_BKGPOOL/.evicted)))
+    done
+    rm -f $CONFIG_BKGPOOL/.evicted
+    [[ ${SIZE:-0} -gt $LIMIT ]] && echo "*!  WARNING! Background pool above ${CONFIG_BKGPOOLMAXSIZE} GB, all the remaining entries are in use"
+    return 0
+}
+
 CONFIG_NEVENTS="200"
 CONFIG_NBKG=""
 CONFIG_BGEVDIR=""
@@ -167,6 +422,13 @@ CONFIG_MATERIAL=""
 CONFIG_KEEPTRACKREFSFRACTION="0"
 CONFIG_REMOVETRACKREFS="off"
 CONFIG_OCDBTIMESTAMP=""
+CONFIG_WORKERS="1"
+CONFIG_CONFIGLIBRARY=""
+CONFIG_BKGPOOL=""
+CONFIG_BKGPOOLSIZE="1"
+CONFIG_BKGPOOLMAXSIZE="0"
+CONFIG_CHECKESDWORKERS="1"
+CONFIG_CHECKESDFRACTION="1"
 
 RUNMODE=""
 
@@ -322,6 +584,16 @@ while [ ! -z "$1" ]; do
         CONFIG_NBKG="$1"
 	export CONFIG_NBKG
         shift
+    elif [ "$option" = "--backgroundPool" ]; then
+        CONFIG_BKGPOOL="$1"
+        [[ $CONFIG_BKGPOOL != /* ]] && CONFIG_BKGPOOL=$PWD/$CONFIG_BKGPOOL
+        shift
+    elif [ "$option" = "--backgroundPoolSize" ]; then
+        CONFIG_BKGPOOLSIZE="$1"
+        shift
+    elif [ "$option" = "--backgroundPoolMaxSize" ]; then
+        CONFIG_BKGPOOLMAXSIZE="$1"
+        shift
     elif [ "$option" = "--ocdb" ]; then
         CONFIG_OCDB="$1"
         if [[ $CONFIG_OCDB == cvmfs* ]]; then
@@ -360,6 +632,22 @@ while [ ! -z "$1" ]; do
 	CONFIG_KEEPTRACKREFSFRACTION="$1"
 	export CONFIG_KEEPTRACKREFSFRACTION
         shift
+    elif [ "$option" = "--configLibrary" ]; then
+        CONFIG_CONFIGLIBRARY="$1"
+        [[ $CONFIG_CONFIGLIBRARY != /* ]] && CONFIG_CONFIGLIBRARY=$PWD/$CONFIG_CONFIGLIBRARY
+        export CONFIG_CONFIGLIBRARY
+        shift
+    elif [ "$option" = "--workers" ]; then
+        CONFIG_WORKERS="$1"
+        shift
+    elif [ "$option" = "--checkESDWorkers" ]; then
+        CONFIG_CHECKESDWORKERS="$1"
+        export CONFIG_CHECKESDWORKERS
+        shift
+    elif [ "$option" = "--checkESDFraction" ]; then
+        CONFIG_CHECKESDFRACTION="$1"
+        export CONFIG_CHECKESDFRACTION
+        shift
     elif [ "$option" = "--OCDBTimeStamp" ]; then
         CONFIG_OCDBTIMESTAMP="$1"
         export CONFIG_OCDBTIMESTAMP
@@ -467,6 +755,26 @@ export CONFIG_REMOVETRACKREFS
 
 # <<<------------------ decide if TrackRefs.root should be removed -----------------<<<
 
+# >>>------------------ event-sharded simulation and reconstruction --------------->>>
+
+if [[ ! $CONFIG_WORKERS =~ ^[0-9]+$ ]] || [ "$CONFIG_WORKERS" -eq 0 ]; then
+    echo "Invalid value $CONFIG_WORKERS provided for workers"
+    exit 1
+fi
+[[ $CONFIG_WORKERS -gt $CONFIG_NEVENTS ]] && CONFIG_WORKERS=$CONFIG_NEVENTS
+if [ "$CONFIG_WORKERS" -gt 1 ]; then
+    if [[ $CONFIG_BACKGROUND != "" ]]; then
+	echo "*!  WARNING! Sharding is not supported for embedding, using 1 worker"
+	CONFIG_WORKERS="1"
+    elif ! ( [[ $CONFIG_MODE == *"full"* ]] || ( [[ $CONFIG_MODE == *"sim"* ]] && [[ $CONFIG_MODE == *"rec"* ]] ) ); then
+	echo "*!  WARNING! Sharding requires both simulation and reconstruction, using 1 worker"
+	CONFIG_WORKERS="1"
+    fi
+fi
+export CONFIG_WORKERS
+
+# <<<------------------ event-sharded simulation and reconstruction ---------------<<<
+
 # mkdir input
 # mv galice.root ./input/galice.root
 # mv Kinematics.root ./input/Kinematics.root
@@ -502,6 +810,29 @@ if [[ $CONFIG_MODE == *"Run3"* ]]; then
     fi
 fi
 
+### LoadConfigLibrary.C, build the compiled configuration library once for all stages
+
+if [[ $CONFIG_CONFIGLIBRARY != "" ]]; then
+
+    # not through runcommand, a failed build is not a job failure: the
+    # stages then run with the interpreted configuration macros
+    echo -e "\n"
+    echo "* CONFIG LIBRARY : $ALIDPG_ROOT/MC/LoadConfigLibrary.C"
+    echo "* CONFIG LIBRARY : output log in configlib.log"
+    START=`date "+%s"`
+    aliroot -b -q -x $ALIDPG_ROOT/MC/LoadConfigLibrary.C >> configlib.log 2>&1
+    exitcode=$?
+    END=`date "+%s"`
+    echo "CONFIG LIBRARY TIME: $((END-START))"
+    grep "^>>>>> timing:" configlib.log | sed "s/^>>>>> timing:/CONFIG LIBRARY TIMING:/"
+    if [ "$exitcode" -ne 0 ] || [ ! -f $CONFIG_CONFIGLIBRARY/ConfigLibrary.ok ]; then
+	echo "*!  WARNING! Configuration library not available, using the interpreted configuration"
+	CONFIG_CONFIGLIBRARY=""
+	export CONFIG_CONFIGLIBRARY
+    fi
+
+fi
+
 ### createSnapshot.C
 
 if [[ $CONFIG_MODE == *"ocdb"* ]]; then
@@ -637,15 +968,38 @@ fi
 
 ### automatic settings from GRP info
 
-aliroot -b -q $ALIDPG_ROOT/MC/ExportGRPinfo.C\($CONFIG_RUN\) 2>/dev/null | grep export > grpdump.sh && source grpdump.sh # && rm grpdump.sh
+CONFIGLIBRARYC=""
+[[ $CONFIG_CONFIGLIBRARY != "" ]] && CONFIGLIBRARYC=$ALIDPG_ROOT/MC/LoadConfigLibrary.C
+aliroot -b -q $CONFIGLIBRARYC $ALIDPG_ROOT/MC/ExportGRPinfo.C\($CONFIG_RUN\) 2>/dev/null | grep export > grpdump.sh && source grpdump.sh # && rm grpdump.sh
 
 ### background from .xml collection
 if [[ $CONFIG_BACKGROUND == *.xml ]]; then
     aliroot -b -q $ALIDPG_ROOT/MC/ExportXMLbackground.C\(\"$CONFIG_BACKGROUND\"\) 2>/dev/null | grep export > xmldump.sh && source xmldump.sh # && rm xmldump.sh    
 fi
 
+### background pool, entry picked by the unique-id of the job
+if [[ $CONFIG_BKGPOOL != "" ]]; then
+    if [[ ! $CONFIG_BKGPOOLSIZE =~ ^[0-9]+$ ]] || [ "$CONFIG_BKGPOOLSIZE" -eq 0 ]; then
+	echo "Invalid value $CONFIG_BKGPOOLSIZE provided for backgroundPoolSize"
+	exit 1
+    fi
+    if [[ ! $CONFIG_BKGPOOLMAXSIZE =~ ^[0-9]+$ ]]; then
+	echo "Invalid value $CONFIG_BKGPOOLMAXSIZE provided for backgroundPoolMaxSize"
+	exit 1
+    fi
+    if [[ $CONFIG_BACKGROUND == "" ]] || ( [[ $CONFIG_BACKGROUND == *galice.root ]] && [[ $CONFIG_BACKGROUND != alien://* ]] ); then
+	echo "*!  WARNING! Background pool requires an AliEn or a generated background, not used"
+	CONFIG_BKGPOOL=""
+    else
+	[[ $CONFIG_NBKG == "" ]] && export CONFIG_NBKG=1
+	# an AliEn background is the same files for every index, one entry per source
+	CONFIG_BKGINDEX=$((CONFIG_UID%CONFIG_BKGPOOLSIZE))
+	[[ $CONFIG_BACKGROUND == alien://* ]] && CONFIG_BKGINDEX=0
+    fi
+fi
+
 ### background from AliEn file, copy files locally
-if [[ $CONFIG_BACKGROUND == alien://* ]]; then
+if [[ $CONFIG_BACKGROUND == alien://* ]] && [[ $CONFIG_BKGPOOL == "" ]]; then
     echo "Copying background files from AliEn to local cache..."
     mkdir -p BKG
     alien_cp ${CONFIG_BACKGROUND%galice.root}/*.zip BKG/.
@@ -698,6 +1052,7 @@ echo "Run.............. $CONFIG_RUN"
 echo "Mode............. $CONFIG_MODE"
 echo "QA train......... $CONFIG_QA"
 echo "AOD train........ $CONFIG_AOD"
+echo "Config library... $CONFIG_CONFIGLIBRARY"
 echo "============================================"
 echo "Year............. $CONFIG_YEAR"
 echo "Period........... $CONFIG_PERIOD"
@@ -711,10 +1066,15 @@ echo "No. Events....... $CONFIG_NEVENTS"
 echo "Unique-ID........ $CONFIG_UID"
 echo "MC seed.......... $CONFIG_SEED"
 echo "PROCID........... $CONFIG_PROCID"
+echo "Workers.......... $CONFIG_WORKERS"
+echo "Check ESD........ $CONFIG_CHECKESDWORKERS workers, fraction $CONFIG_CHECKESDFRACTION"
 echo "============================================"
 echo "Background....... $CONFIG_BACKGROUND"
 echo "Override record.. $OVERRIDE_BKG_PATH_RECORD"
 echo "No. Events....... $CONFIG_NBKG"
+echo "Background pool.. $CONFIG_BKGPOOL"
+echo "Pool entry....... $CONFIG_BKGINDEX / $CONFIG_BKGPOOLSIZE"
+echo "Pool max size.... $CONFIG_BKGPOOLMAXSIZE GB"
 #echo "MC seed.......... $CONFIG_SEED (based on $CONFIG_SEED_BASED)"
 echo "============================================"
 echo "Detector......... $CONFIG_DETECTOR"
@@ -777,6 +1137,11 @@ if [[ $CONFIG_MODE == *"sim"* ]] || [[ $CONFIG_MODE == *"full"* ]]; then
 	SIMC=sim.C
     fi
 
+    # embedding using the background pool
+    if [[ $CONFIG_BKGPOOL != "" ]]; then
+	backgroundPool $SIMC
+    fi
+
     # embedding using already generated background
     if [[ $CONFIG_BACKGROUND == *galice.root ]]; then
 
@@ -819,8 +1184,22 @@ if [[ $CONFIG_MODE == *"sim"* ]] || [[ $CONFIG_MODE == *"full"* ]]; then
 	
     fi
 
-    runcommand "SIMULATION" $SIMC sim.log 5
-    mv -f syswatch.log simwatch.log
+    if [ "$CONFIG_WORKERS" -gt 1 ]; then
+
+	RECC=$ALIDPG_ROOT/MC/rec.C
+	if [ -f rec.C ]; then
+	    RECC=rec.C
+	fi
+
+	echo ">>>>> SHARDING: $CONFIG_NEVENTS events in $CONFIG_WORKERS shards"
+	runshards $SIMC $RECC
+
+    else
+
+	runcommand "SIMULATION" $SIMC sim.log 5
+	mv -f syswatch.log simwatch.log
+
+    fi
 
     runBenchmark
 
@@ -835,8 +1214,11 @@ if [[ $CONFIG_MODE == *"rec"* ]] || [[ $CONFIG_MODE == *"full"* ]]; then
 	RECC=rec.C
     fi
 
-    runcommand "RECONSTRUCTION" $RECC rec.log 10
-    mv -f syswatch.log recwatch.log
+    # already reconstructed and merged by the shards
+    if [ "$CONFIG_WORKERS" -le 1 ]; then
+	runcommand "RECONSTRUCTION" $RECC rec.log 10
+	mv -f syswatch.log recwatch.log
+    fi
     if [ ! -f AliESDs.root ]; then
 	echo "*! Could not find AliESDs.root, the simulation/reconstruction chain failed!"
 	echo "Could not find AliESDs.root, the simulation/reconstruction chain failed!" >> validation_error.message